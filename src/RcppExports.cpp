@@ -44,6 +44,18 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// fstasdataframe
+SEXP fstasdataframe(SEXP table, SEXP nrOfRows);
+RcppExport SEXP _fst_fstasdataframe(SEXP tableSEXP, SEXP nrOfRowsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type table(tableSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type nrOfRows(nrOfRowsSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstasdataframe(table, nrOfRows));
+    return rcpp_result_gen;
+END_RCPP
+}
 // fsthasher
 SEXP fsthasher(SEXP rawVec, SEXP seed, SEXP blockHash);
 RcppExport SEXP _fst_fsthasher(SEXP rawVecSEXP, SEXP seedSEXP, SEXP blockHashSEXP) {
@@ -57,6 +69,32 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// fsthashervector
+SEXP fsthashervector(SEXP vec, SEXP seed, SEXP blockHash);
+RcppExport SEXP _fst_fsthashervector(SEXP vecSEXP, SEXP seedSEXP, SEXP blockHashSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type vec(vecSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type blockHash(blockHashSEXP);
+    rcpp_result_gen = Rcpp::wrap(fsthashervector(vec, seed, blockHash));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fsthasherlist
+SEXP fsthasherlist(SEXP vecs, SEXP seed, SEXP blockHash);
+RcppExport SEXP _fst_fsthasherlist(SEXP vecsSEXP, SEXP seedSEXP, SEXP blockHashSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type vecs(vecsSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type seed(seedSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type blockHash(blockHashSEXP);
+    rcpp_result_gen = Rcpp::wrap(fsthasherlist(vecs, seed, blockHash));
+    return rcpp_result_gen;
+END_RCPP
+}
 // fstcomp
 SEXP fstcomp(SEXP rawVec, SEXP compressor, SEXP compression, SEXP hash);
 RcppExport SEXP _fst_fstcomp(SEXP rawVecSEXP, SEXP compressorSEXP, SEXP compressionSEXP, SEXP hashSEXP) {
@@ -82,6 +120,32 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// hasaltrep
+SEXP hasaltrep();
+RcppExport SEXP _fst_hasaltrep() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(hasaltrep());
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstlazycolumn
+SEXP fstlazycolumn(SEXP fileName, SEXP columnName, SEXP startRow, SEXP length, SEXP columnType, SEXP fileInfo);
+RcppExport SEXP _fst_fstlazycolumn(SEXP fileNameSEXP, SEXP columnNameSEXP, SEXP startRowSEXP, SEXP lengthSEXP, SEXP columnTypeSEXP, SEXP fileInfoSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type columnName(columnNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type startRow(startRowSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type length(lengthSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type columnType(columnTypeSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type fileInfo(fileInfoSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstlazycolumn(fileName, columnName, startRow, length, columnType, fileInfo));
+    return rcpp_result_gen;
+END_RCPP
+}
 // getnrofthreads
 SEXP getnrofthreads();
 RcppExport SEXP _fst_getnrofthreads() {
@@ -128,9 +192,14 @@ static const R_CallMethodDef CallEntries[] = {
     {"_fst_fststore", (DL_FUNC) &_fst_fststore, 4},
     {"_fst_fstmetadata", (DL_FUNC) &_fst_fstmetadata, 1},
     {"_fst_fstretrieve", (DL_FUNC) &_fst_fstretrieve, 4},
+    {"_fst_fstasdataframe", (DL_FUNC) &_fst_fstasdataframe, 2},
     {"_fst_fsthasher", (DL_FUNC) &_fst_fsthasher, 3},
+    {"_fst_fsthasherlist", (DL_FUNC) &_fst_fsthasherlist, 3},
+    {"_fst_fsthashervector", (DL_FUNC) &_fst_fsthashervector, 3},
     {"_fst_fstcomp", (DL_FUNC) &_fst_fstcomp, 4},
     {"_fst_fstdecomp", (DL_FUNC) &_fst_fstdecomp, 1},
+    {"_fst_hasaltrep", (DL_FUNC) &_fst_hasaltrep, 0},
+    {"_fst_fstlazycolumn", (DL_FUNC) &_fst_fstlazycolumn, 6},
     {"_fst_getnrofthreads", (DL_FUNC) &_fst_getnrofthreads, 0},
     {"_fst_setnrofthreads", (DL_FUNC) &_fst_setnrofthreads, 1},
     {"_fst_restore_after_fork", (DL_FUNC) &_fst_restore_after_fork, 1},
@@ -138,7 +207,9 @@ static const R_CallMethodDef CallEntries[] = {
     {NULL, NULL, 0}
 };
 
+void init_lazy_column(DllInfo* dll);
 RcppExport void R_init_fst(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    init_lazy_column(dll);
 }
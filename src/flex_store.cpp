@@ -45,3 +45,27 @@ SEXP fstretrieve(Rcpp::String fileName, SEXP columnSelection, SEXP startRow, SEX
 {
   return fstcore::fstretrieve(fileName, columnSelection, startRow, endRow);
 }
+
+
+// Turn a list of columns created by fstretrieve into a data.frame. The attributes are set in place (without
+// copying the list), so the list should not be referenced by other objects.
+// [[Rcpp::export]]
+SEXP fstasdataframe(SEXP table, SEXP nrOfRows)
+{
+  int nr_of_rows = Rf_asInteger(nrOfRows);
+
+  Rf_setAttrib(table, R_ClassSymbol, Rf_mkString("data.frame"));
+
+  // compact row names c(NA, -nr_of_rows), identical to base::.set_row_names
+  SEXP row_names = PROTECT(Rf_allocVector(INTSXP, nr_of_rows > 0 ? 2 : 0));
+
+  if (nr_of_rows > 0) {
+    INTEGER(row_names)[0] = NA_INTEGER;
+    INTEGER(row_names)[1] = -nr_of_rows;
+  }
+
+  Rf_setAttrib(table, R_RowNamesSymbol, row_names);
+  UNPROTECT(1);
+
+  return table;
+}
@@ -22,6 +22,9 @@
 */
 
 
+#include <cstring>
+#include <vector>
+
 #include <Rcpp.h>
 
 #include <fstcore.h>
@@ -34,6 +37,288 @@ SEXP fsthasher(SEXP rawVec, SEXP seed, SEXP blockHash)
 }
 
 
+// Atomic vectors are hashed from the memory of their elements, without creating a raw copy of the complete
+// vector. The elements are copied to a buffer of at most FST_HASH_CHUNK bytes, and each full buffer is hashed
+// separately. The hash of a vector with more than a single chunk is the hash of its chunk hashes. Each
+// element of a character vector is hashed as its length (4 bytes) followed by its UTF-8 bytes, NA's have
+// length -1. For factors, the levels are hashed after the integer codes.
+#define FST_HASH_CHUNK 16777216
+
+
+// Raw vector used as the buffer of a chunk. The hasher uses the length of the raw vector, so the buffer is
+// sized to the exact length of the chunk and only reallocated when the next chunk has a different length.
+// With a list of equally sized vectors, a single buffer is used for all elements.
+struct HashBuffer
+{
+  SEXP vec;
+  PROTECT_INDEX index;
+};
+
+
+// state of the hash calculation of a single vector
+struct HashStream
+{
+  HashBuffer* buffer;
+  R_xlen_t pos;  // number of bytes used in the buffer
+  R_xlen_t size;  // size of the current chunk
+  R_xlen_t remaining;  // number of bytes of the vector that are not yet part of a hashed chunk
+  std::vector<int> chunk_hashes;
+  SEXP seed;
+  SEXP block_hash;
+  SEXP error;  // error returned by the hasher (or R_NilValue)
+};
+
+
+// size the buffer for the next chunk
+static void start_chunk(HashStream& stream)
+{
+  stream.size = stream.remaining < FST_HASH_CHUNK ? stream.remaining : FST_HASH_CHUNK;
+  stream.pos = 0;
+
+  if (stream.buffer->vec == R_NilValue || XLENGTH(stream.buffer->vec) != stream.size)
+  {
+    stream.buffer->vec = Rf_allocVector(RAWSXP, stream.size);
+    R_Reprotect(stream.buffer->vec, stream.buffer->index);
+  }
+}
+
+
+// hash the (full) buffer and start the next chunk
+static bool hash_chunk(HashStream& stream)
+{
+  SEXP hash = fstcore::fsthasher(stream.buffer->vec, stream.seed, stream.block_hash);
+
+  if (TYPEOF(hash) != INTSXP)
+  {
+    stream.error = hash;
+    return false;
+  }
+
+  stream.chunk_hashes.push_back(INTEGER(hash)[0]);
+  stream.chunk_hashes.push_back(INTEGER(hash)[1]);
+
+  stream.remaining -= stream.size;
+  if (stream.remaining > 0) start_chunk(stream);
+
+  return true;
+}
+
+
+// add 'length' bytes to the hash
+static bool hash_write(HashStream& stream, const void* data, R_xlen_t length)
+{
+  const char* bytes = (const char*) data;
+
+  while (length > 0)
+  {
+    R_xlen_t size = stream.size - stream.pos;
+    if (size > length) size = length;
+
+    memcpy(RAW(stream.buffer->vec) + stream.pos, bytes, size);
+    stream.pos += size;
+    bytes += size;
+    length -= size;
+
+    if (stream.pos == stream.size && !hash_chunk(stream)) return false;
+  }
+
+  return true;
+}
+
+
+// number of bytes used to hash a character vector
+static R_xlen_t strings_size(SEXP str_vec)
+{
+  R_xlen_t nr_of_elements = XLENGTH(str_vec);
+  R_xlen_t size = 4 * nr_of_elements;
+
+  for (R_xlen_t element = 0; element < nr_of_elements; element++)
+  {
+    SEXP str = STRING_ELT(str_vec, element);
+    if (str == NA_STRING) continue;
+
+    const void* vmax = vmaxget();
+    size += (R_xlen_t) strlen(Rf_translateCharUTF8(str));
+    vmaxset(vmax);
+  }
+
+  return size;
+}
+
+
+static bool hash_strings(HashStream& stream, SEXP str_vec)
+{
+  R_xlen_t nr_of_elements = XLENGTH(str_vec);
+
+  for (R_xlen_t element = 0; element < nr_of_elements; element++)
+  {
+    SEXP str = STRING_ELT(str_vec, element);
+
+    // NA's are hashed differently from string "NA"
+    if (str == NA_STRING)
+    {
+      int na_length = -1;
+      if (!hash_write(stream, &na_length, 4)) return false;
+      continue;
+    }
+
+    const void* vmax = vmaxget();
+    const char* utf8_str = Rf_translateCharUTF8(str);
+    int str_length = (int) strlen(utf8_str);
+
+    bool success = hash_write(stream, &str_length, 4) && hash_write(stream, utf8_str, str_length);
+    vmaxset(vmax);
+
+    if (!success) return false;
+  }
+
+  return true;
+}
+
+
+// Hash of a single vector using (and possibly resizing) 'buffer'. Returns an integer vector of length two or
+// the error of the hasher. Raw vectors are hashed directly, identical to fsthasher.
+static SEXP hash_vector(SEXP vec, SEXP seed, SEXP blockHash, HashBuffer* buffer)
+{
+  bool is_factor = false;
+  R_xlen_t total_size = 0;
+
+  switch (TYPEOF(vec))
+  {
+    case RAWSXP:
+      return fstcore::fsthasher(vec, seed, blockHash);
+
+    case LGLSXP:
+    case INTSXP:
+      total_size = XLENGTH(vec) * sizeof(int);
+      is_factor = Rf_isFactor(vec);
+      if (is_factor) total_size += strings_size(Rf_getAttrib(vec, R_LevelsSymbol));
+      break;
+
+    case REALSXP:
+      total_size = XLENGTH(vec) * sizeof(double);
+      break;
+
+    case CPLXSXP:
+      total_size = XLENGTH(vec) * sizeof(Rcomplex);
+      break;
+
+    case STRSXP:
+      total_size = strings_size(vec);
+      break;
+
+    default:
+      Rf_error("Please specify a raw vector, an atomic vector or a list of those as input parameter x.");
+  }
+
+  HashStream stream;
+  stream.buffer = buffer;
+  stream.remaining = total_size;
+  stream.seed = seed;
+  stream.block_hash = blockHash;
+  stream.error = R_NilValue;
+
+  start_chunk(stream);
+
+  bool success = true;
+
+  switch (TYPEOF(vec))
+  {
+    case LGLSXP:
+    case INTSXP:
+      success = hash_write(stream, INTEGER(vec), XLENGTH(vec) * sizeof(int));
+      if (success && is_factor) success = hash_strings(stream, Rf_getAttrib(vec, R_LevelsSymbol));
+      break;
+
+    case REALSXP:
+      success = hash_write(stream, REAL(vec), XLENGTH(vec) * sizeof(double));
+      break;
+
+    case CPLXSXP:
+      success = hash_write(stream, COMPLEX(vec), XLENGTH(vec) * sizeof(Rcomplex));
+      break;
+
+    case STRSXP:
+      success = hash_strings(stream, vec);
+      break;
+  }
+
+  // an empty vector is hashed as an empty chunk
+  if (success && total_size == 0) success = hash_chunk(stream);
+
+  if (!success) return stream.error;
+
+  SEXP hash;
+
+  if (stream.chunk_hashes.size() == 2)
+  {
+    hash = PROTECT(Rf_allocVector(INTSXP, 2));
+    INTEGER(hash)[0] = stream.chunk_hashes[0];
+    INTEGER(hash)[1] = stream.chunk_hashes[1];
+    UNPROTECT(1);
+    return hash;
+  }
+
+  // hash of the chunk hashes
+  SEXP chunk_hashes = PROTECT(Rf_allocVector(RAWSXP, stream.chunk_hashes.size() * sizeof(int)));
+  memcpy(RAW(chunk_hashes), stream.chunk_hashes.data(), stream.chunk_hashes.size() * sizeof(int));
+  hash = fstcore::fsthasher(chunk_hashes, seed, blockHash);
+  UNPROTECT(1);
+
+  return hash;
+}
+
+
+// Hash an atomic vector without creating a raw copy first.
+// [[Rcpp::export]]
+SEXP fsthashervector(SEXP vec, SEXP seed, SEXP blockHash)
+{
+  HashBuffer buffer;
+  buffer.vec = R_NilValue;
+  PROTECT_WITH_INDEX(buffer.vec, &buffer.index);
+
+  SEXP hash = hash_vector(vec, seed, blockHash, &buffer);
+
+  UNPROTECT(1);
+  return hash;
+}
+
+
+// Hash each (raw or atomic) vector in list 'vecs', the result is an integer matrix with a row per hash. This
+// avoids the overhead of a separate call from R for each (small) vector.
+// [[Rcpp::export]]
+SEXP fsthasherlist(SEXP vecs, SEXP seed, SEXP blockHash)
+{
+  R_xlen_t nr_of_vecs = XLENGTH(vecs);
+
+  SEXP hashes = PROTECT(Rf_allocMatrix(INTSXP, nr_of_vecs, 2));
+  int* hash_values = INTEGER(hashes);
+
+  // buffer shared by all elements
+  HashBuffer buffer;
+  buffer.vec = R_NilValue;
+  PROTECT_WITH_INDEX(buffer.vec, &buffer.index);
+
+  for (R_xlen_t vec_index = 0; vec_index < nr_of_vecs; vec_index++)
+  {
+    SEXP hash = hash_vector(VECTOR_ELT(vecs, vec_index), seed, blockHash, &buffer);
+
+    // return errors to the caller
+    if (TYPEOF(hash) != INTSXP)
+    {
+      UNPROTECT(2);
+      return hash;
+    }
+
+    hash_values[vec_index] = INTEGER(hash)[0];
+    hash_values[vec_index + nr_of_vecs] = INTEGER(hash)[1];
+  }
+
+  UNPROTECT(2);
+  return hashes;
+}
+
+
 // [[Rcpp::export]]
 SEXP fstcomp(SEXP rawVec, SEXP compressor, SEXP compression, SEXP hash)
 {
@@ -0,0 +1,380 @@
+/*
+ fst - R package for ultra fast storage and retrieval of datasets
+
+ Copyright (C) 2017-present, Mark AJ Klik
+
+ This file is part of the fst R package.
+
+ The fst R package is free software: you can redistribute it and/or modify it
+ under the terms of the GNU Affero General Public License version 3 as
+ published by the Free Software Foundation.
+
+ The fst R package is distributed in the hope that it will be useful, but
+ WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License
+ for more details.
+
+ You should have received a copy of the GNU Affero General Public License along
+ with the fst R package. If not, see <http://www.gnu.org/licenses/>.
+
+ You can contact the author at:
+ - fst R package source repository : https://github.com/fstpackage/fst
+*/
+
+
+#include <cstring>
+
+#include <Rcpp.h>
+#include <Rversion.h>
+
+
+// ALTREP classes for integer, double and logical vectors that are backed by a column of a fst file.
+// Elements are retrieved from file when they are accessed: single elements are read (and cached) in
+// windows of FST_LAZY_WINDOW rows, larger regions are read directly. When regions are requested in
+// consecutive order (as R does when iterating over a vector in sum() or mean()), the size of the next
+// window is doubled, up to FST_LAZY_MAX_WINDOW rows. The full vector is only read (materialized) when a
+// pointer to the data is requested.
+//
+// The state of a lazy vector is stored in the first data slot as a list with elements:
+//   0: path of the fst file
+//   1: name of the column
+//   2: length of the vector
+//   3: first row of the column in file (zero based)
+//   4: zero based index of the first element of the cached window (-1 if no window)
+//   5: cached window values
+//   6: size and modification time of the fst file when the vector was created
+//   7: number of rows of the next window
+// The second data slot contains the materialized vector (or R_NilValue).
+//
+// Each read checks that the fst file is unchanged and that the result has the expected type and length,
+// an R error is raised otherwise.
+//
+// The R API is used instead of Rcpp in the ALTREP methods, because an R error can be raised while
+// reading from file. Such errors long jump through these methods, so no C++ objects with destructors
+// are allocated here.
+
+
+#if defined(R_VERSION) && R_VERSION >= R_Version(3, 6, 0)
+
+#define FST_HAS_ALTREP
+
+#include <R_ext/Altrep.h>
+
+
+#define FST_LAZY_WINDOW 4096
+#define FST_LAZY_MAX_WINDOW 16777216
+
+static R_altrep_class_t lazy_integer_class;
+static R_altrep_class_t lazy_real_class;
+static R_altrep_class_t lazy_logical_class;
+
+
+// read rows [from, to] (zero based, inclusive) of the column of lazy vector x
+static SEXP lazy_read(SEXP x, R_xlen_t from, R_xlen_t to)
+{
+  SEXP info = R_altrep_data1(x);
+  double row_offset = REAL(VECTOR_ELT(info, 3))[0];
+
+  SEXP ns = PROTECT(R_FindNamespace(Rf_mkString("fst")));
+  SEXP fun = PROTECT(Rf_findFun(Rf_install(".lazy_column_read"), ns));
+  SEXP from_row = PROTECT(Rf_ScalarReal(row_offset + from + 1));
+  SEXP to_row = PROTECT(Rf_ScalarReal(row_offset + to + 1));
+  SEXP call = PROTECT(Rf_lang6(fun, VECTOR_ELT(info, 0), VECTOR_ELT(info, 1), from_row, to_row,
+    VECTOR_ELT(info, 6)));
+
+  SEXP values = PROTECT(Rf_eval(call, ns));
+
+  // the values are copied into R's buffers, so a mismatch would lead to invalid memory access
+  if (TYPEOF(values) != TYPEOF(x) || XLENGTH(values) != to - from + 1)
+  {
+    Rf_error("Unexpected data read for lazy column '%s', the fst file might have been changed",
+      CHAR(STRING_ELT(VECTOR_ELT(info, 1), 0)));
+  }
+
+  UNPROTECT(6);
+  return values;
+}
+
+
+static R_xlen_t lazy_length(SEXP x)
+{
+  return (R_xlen_t) REAL(VECTOR_ELT(R_altrep_data1(x), 2))[0];
+}
+
+
+static void* vector_dataptr(SEXP vec)
+{
+  switch (TYPEOF(vec))
+  {
+    case INTSXP:
+      return (void*) INTEGER(vec);
+
+    case LGLSXP:
+      return (void*) LOGICAL(vec);
+
+    case REALSXP:
+      return (void*) REAL(vec);
+
+    default:
+      Rf_error("Unexpected vector type for a lazy column");
+      return NULL;
+  }
+}
+
+
+// read the complete column and store it in the second data slot
+static SEXP lazy_materialize(SEXP x)
+{
+  SEXP data = R_altrep_data2(x);
+
+  if (data != R_NilValue) return data;
+
+  data = PROTECT(lazy_read(x, 0, lazy_length(x) - 1));
+  R_set_altrep_data2(x, data);
+
+  // the window cache is no longer needed
+  SET_VECTOR_ELT(R_altrep_data1(x), 5, R_NilValue);
+
+  UNPROTECT(1);
+  return data;
+}
+
+
+static void* lazy_dataptr(SEXP x, Rboolean writeable)
+{
+  return vector_dataptr(lazy_materialize(x));
+}
+
+
+static const void* lazy_dataptr_or_null(SEXP x)
+{
+  SEXP data = R_altrep_data2(x);
+
+  if (data == R_NilValue) return NULL;
+
+  return vector_dataptr(data);
+}
+
+
+// Cached window of values containing element i, 'window_start' is set to the index of the first element.
+// With 'sequential' set, a request for the element directly following the cached window doubles the
+// window size.
+static SEXP lazy_window(SEXP x, R_xlen_t i, R_xlen_t* window_start, bool sequential)
+{
+  SEXP info = R_altrep_data1(x);
+  SEXP values = VECTOR_ELT(info, 5);
+  double* cached_start = REAL(VECTOR_ELT(info, 4));
+  double* window_size = REAL(VECTOR_ELT(info, 7));
+
+  if (values != R_NilValue && i >= *cached_start && i < *cached_start + XLENGTH(values))
+  {
+    *window_start = (R_xlen_t) *cached_start;
+    return values;
+  }
+
+  R_xlen_t start = (i / FST_LAZY_WINDOW) * FST_LAZY_WINDOW;
+  R_xlen_t size = FST_LAZY_WINDOW;
+
+  if (sequential && values != R_NilValue && i == *cached_start + XLENGTH(values))
+  {
+    start = i;
+    size = 2 * (R_xlen_t) *window_size;
+    if (size > FST_LAZY_MAX_WINDOW) size = FST_LAZY_MAX_WINDOW;
+  }
+
+  R_xlen_t length = lazy_length(x);
+  R_xlen_t end = start + size - 1;
+  if (end >= length) end = length - 1;
+
+  values = PROTECT(lazy_read(x, start, end));
+  SET_VECTOR_ELT(info, 5, values);
+  *cached_start = (double) start;
+  *window_size = (double) size;
+
+  UNPROTECT(1);
+
+  *window_start = start;
+  return values;
+}
+
+
+// copy region [i, i + n) to buffer 'buf' with element size 'size', returns the number of copied elements
+static R_xlen_t lazy_get_region(SEXP x, R_xlen_t i, R_xlen_t n, void* buf, size_t size)
+{
+  R_xlen_t length = lazy_length(x);
+  if (i + n > length) n = length - i;
+  if (n <= 0) return 0;
+
+  SEXP data = R_altrep_data2(x);
+
+  if (data != R_NilValue)
+  {
+    memcpy(buf, (char*) vector_dataptr(data) + i * size, n * size);
+    return n;
+  }
+
+  // small regions (such as the buffers used by R's internal iteration) are served from the window
+  // cache, only the elements up to the end of the window are copied
+  if (n <= FST_LAZY_WINDOW)
+  {
+    R_xlen_t window_start;
+    SEXP values = lazy_window(x, i, &window_start, true);
+
+    R_xlen_t window_end = window_start + XLENGTH(values);
+    if (i < window_start || i >= window_end) Rf_error("Invalid window for lazy column");
+    if (i + n > window_end) n = window_end - i;
+
+    memcpy(buf, (char*) vector_dataptr(values) + (i - window_start) * size, n * size);
+    return n;
+  }
+
+  SEXP values = PROTECT(lazy_read(x, i, i + n - 1));
+  memcpy(buf, vector_dataptr(values), n * size);
+  UNPROTECT(1);
+
+  return n;
+}
+
+
+static int lazy_integer_elt(SEXP x, R_xlen_t i)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) return INTEGER(data)[i];
+
+  R_xlen_t window_start;
+  SEXP values = lazy_window(x, i, &window_start, false);
+
+  return INTEGER(values)[i - window_start];
+}
+
+
+static R_xlen_t lazy_integer_get_region(SEXP x, R_xlen_t i, R_xlen_t n, int* buf)
+{
+  return lazy_get_region(x, i, n, (void*) buf, sizeof(int));
+}
+
+
+static double lazy_real_elt(SEXP x, R_xlen_t i)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) return REAL(data)[i];
+
+  R_xlen_t window_start;
+  SEXP values = lazy_window(x, i, &window_start, false);
+
+  return REAL(values)[i - window_start];
+}
+
+
+static R_xlen_t lazy_real_get_region(SEXP x, R_xlen_t i, R_xlen_t n, double* buf)
+{
+  return lazy_get_region(x, i, n, (void*) buf, sizeof(double));
+}
+
+
+static int lazy_logical_elt(SEXP x, R_xlen_t i)
+{
+  SEXP data = R_altrep_data2(x);
+  if (data != R_NilValue) return LOGICAL(data)[i];
+
+  R_xlen_t window_start;
+  SEXP values = lazy_window(x, i, &window_start, false);
+
+  return LOGICAL(values)[i - window_start];
+}
+
+
+static R_xlen_t lazy_logical_get_region(SEXP x, R_xlen_t i, R_xlen_t n, int* buf)
+{
+  return lazy_get_region(x, i, n, (void*) buf, sizeof(int));
+}
+
+
+static Rboolean lazy_inspect(SEXP x, int pre, int deep, int pvec, void (*inspect_subtree)(SEXP, int, int, int))
+{
+  Rprintf("fst lazy column (%s)\n", R_altrep_data2(x) == R_NilValue ? "not materialized" : "materialized");
+  return TRUE;
+}
+
+
+#endif
+
+
+// [[Rcpp::init]]
+void init_lazy_column(DllInfo* dll)
+{
+#ifdef FST_HAS_ALTREP
+  lazy_integer_class = R_make_altinteger_class("fst_lazy_integer", "fst", dll);
+  R_set_altrep_Length_method(lazy_integer_class, lazy_length);
+  R_set_altrep_Inspect_method(lazy_integer_class, lazy_inspect);
+  R_set_altvec_Dataptr_method(lazy_integer_class, lazy_dataptr);
+  R_set_altvec_Dataptr_or_null_method(lazy_integer_class, lazy_dataptr_or_null);
+  R_set_altinteger_Elt_method(lazy_integer_class, lazy_integer_elt);
+  R_set_altinteger_Get_region_method(lazy_integer_class, lazy_integer_get_region);
+
+  lazy_real_class = R_make_altreal_class("fst_lazy_real", "fst", dll);
+  R_set_altrep_Length_method(lazy_real_class, lazy_length);
+  R_set_altrep_Inspect_method(lazy_real_class, lazy_inspect);
+  R_set_altvec_Dataptr_method(lazy_real_class, lazy_dataptr);
+  R_set_altvec_Dataptr_or_null_method(lazy_real_class, lazy_dataptr_or_null);
+  R_set_altreal_Elt_method(lazy_real_class, lazy_real_elt);
+  R_set_altreal_Get_region_method(lazy_real_class, lazy_real_get_region);
+
+  lazy_logical_class = R_make_altlogical_class("fst_lazy_logical", "fst", dll);
+  R_set_altrep_Length_method(lazy_logical_class, lazy_length);
+  R_set_altrep_Inspect_method(lazy_logical_class, lazy_inspect);
+  R_set_altvec_Dataptr_method(lazy_logical_class, lazy_dataptr);
+  R_set_altvec_Dataptr_or_null_method(lazy_logical_class, lazy_dataptr_or_null);
+  R_set_altlogical_Elt_method(lazy_logical_class, lazy_logical_elt);
+  R_set_altlogical_Get_region_method(lazy_logical_class, lazy_logical_get_region);
+#endif
+}
+
+
+// [[Rcpp::export]]
+SEXP hasaltrep()
+{
+#ifdef FST_HAS_ALTREP
+  return Rf_ScalarLogical(TRUE);
+#else
+  return Rf_ScalarLogical(FALSE);
+#endif
+}
+
+
+// [[Rcpp::export]]
+SEXP fstlazycolumn(SEXP fileName, SEXP columnName, SEXP startRow, SEXP length, SEXP columnType, SEXP fileInfo)
+{
+#ifdef FST_HAS_ALTREP
+  SEXP info = PROTECT(Rf_allocVector(VECSXP, 8));
+
+  SET_VECTOR_ELT(info, 0, fileName);
+  SET_VECTOR_ELT(info, 1, columnName);
+  SET_VECTOR_ELT(info, 2, Rf_ScalarReal(Rf_asReal(length)));
+  SET_VECTOR_ELT(info, 3, Rf_ScalarReal(Rf_asReal(startRow) - 1));
+  SET_VECTOR_ELT(info, 4, Rf_ScalarReal(-1));
+  SET_VECTOR_ELT(info, 5, R_NilValue);
+  SET_VECTOR_ELT(info, 6, fileInfo);
+  SET_VECTOR_ELT(info, 7, Rf_ScalarReal(FST_LAZY_WINDOW));
+
+  const char* column_type = CHAR(STRING_ELT(columnType, 0));
+  R_altrep_class_t lazy_class = lazy_real_class;
+
+  if (strcmp(column_type, "integer") == 0)
+  {
+    lazy_class = lazy_integer_class;
+  }
+  else if (strcmp(column_type, "logical") == 0)
+  {
+    lazy_class = lazy_logical_class;
+  }
+
+  SEXP res = R_new_altrep(lazy_class, info, R_NilValue);
+
+  UNPROTECT(1);
+  return res;
+#else
+  Rcpp::stop("Lazy columns require R version 3.6.0 or higher");
+  return R_NilValue;
+#endif
+}